@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 #include <unistd.h>
@@ -11,6 +12,12 @@
 #include <arpa/inet.h>
 
 
+// Keep each datagram within a single Ethernet frame (1500 - 20 bytes IP header - 8 bytes UDP header).
+// IP reassembly is disabled on the station, so fragmented datagrams are dropped in lwIP before reaching the UDP layer.
+#define PAYLOAD_SIZE 1472
+// Number of datagrams sent every period, about 20[KiB] in total.
+#define DATAGRAMS_PER_PERIOD 14
+
 int main(int argc, char* argv[]) 
 {
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
@@ -18,21 +25,32 @@ int main(int argc, char* argv[])
 
     addr.sin_family = AF_INET;
     addr.sin_port = htons(10000);
-    addr.sin_addr.s_addr = inet_addr("192.168.2.14");
+    addr.sin_addr.s_addr = inet_addr(argc > 1 ? argv[1] : "192.168.2.14");
 
-    uint8_t data[20240];
+    uint8_t data[PAYLOAD_SIZE];
+    // Sequence counter and session ID at the head of each datagram to detect lost packets on the station.
+    // The session ID lets the station tell a restart of this program from reordered packets.
+    uint32_t sequence = 0;
+    uint32_t session_be = htonl((uint32_t)time(NULL) ^ ((uint32_t)getpid() << 16));
+    memcpy(data + sizeof(uint32_t), &session_be, sizeof(session_be));
 
     struct timespec start_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
     size_t total_bytes_sent = 0;
 
     while(true) {
-        ssize_t bytes_sent = sendto(sock, data, sizeof(data), 0, (const struct sockaddr*)&addr, sizeof(addr));
-        if( bytes_sent < 0 ) {
-            printf("error\n");
-        }
-        else {
-            total_bytes_sent += bytes_sent;
+        for(int i = 0; i < DATAGRAMS_PER_PERIOD; i++) {
+            uint32_t sequence_be = htonl(sequence);
+            memcpy(data, &sequence_be, sizeof(sequence_be));
+            ssize_t bytes_sent = sendto(sock, data, sizeof(data), 0, (const struct sockaddr*)&addr, sizeof(addr));
+            if( bytes_sent < 0 ) {
+                printf("error\n");
+            }
+            else {
+                // Only count datagrams actually sent, so that send errors are not reported as lost packets on the station.
+                sequence++;
+                total_bytes_sent += bytes_sent;
+            }
         }
         {
             struct timespec ts;
@@ -44,7 +62,7 @@ int main(int argc, char* argv[])
                 total_bytes_sent = 0;
             }
         }
-        // wait 100[ms]
+        // wait 20[ms]
         {
             struct timespec ts;
             ts.tv_sec = 0;
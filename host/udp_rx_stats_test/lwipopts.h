@@ -0,0 +1,34 @@
+/* lwIP options to build the UDP receive statistics against the lwIP unix port. */
+#ifndef LWIPOPTS_H__
+#define LWIPOPTS_H__
+
+#define NO_SYS                      0
+#define SYS_LIGHTWEIGHT_PROT        1
+
+#define MEM_ALIGNMENT               4
+#define MEM_SIZE                    (64*1024)
+#define PBUF_POOL_SIZE              32
+#define TCPIP_MBOX_SIZE             32
+#define DEFAULT_UDP_RECVMBOX_SIZE   32
+
+#define LWIP_IPV4                   1
+#define LWIP_IPV6                   0
+#define LWIP_ARP                    0
+#define LWIP_ETHERNET               0
+#define LWIP_TCP                    0
+#define LWIP_UDP                    1
+#define LWIP_NETCONN                0
+#define LWIP_SOCKET                 0
+
+// Same as the station configuration.
+#define IP_REASSEMBLY               0
+#define IP_FRAG                     0
+
+// Packets sent to 127.0.0.1 are delivered through the loopback interface.
+#define LWIP_NETIF_LOOPBACK         1
+#define LWIP_HAVE_LOOPIF            1
+
+#define LWIP_STATS                  1
+#define LWIP_STATS_DISPLAY          0
+
+#endif  // LWIPOPTS_H__
@@ -0,0 +1,207 @@
+/* Checks the UDP receive statistics of the station on Linux.
+
+   Sequenced datagrams are sent to 127.0.0.1 through the loopback interface
+   of the lwIP unix port and received by udp_rx_stats_recv().
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "lwip/def.h"
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+
+#include "udp_rx_stats.h"
+
+#define TEST_PORT 10000
+
+typedef struct {
+    uint32_t session;
+    uint32_t first_sequence;
+    uint32_t count;
+    uint16_t size;
+} SendPhase;
+
+static const SendPhase phases[] = {
+    {1,   0, 100, 64},  // In order.
+    {1, 105,  95, 64},  // 100 to 104 are lost.
+    {1, 150,   1, 64},  // Duplicated.
+    {1, 190,   1, 64},  // Duplicated.
+    {2,   0,  50, 64},  // Sender restarted.
+    {2,  50,   1,  2},  // Too short to hold the header.
+};
+
+typedef struct {
+    const SendPhase* phase;
+    sys_sem_t done;
+} SendRequest;
+
+static struct udp_pcb* sender = NULL;
+static int failures = 0;
+
+static void send_callback(void* ctx)
+{
+    SendRequest* request = (SendRequest*)ctx;
+    const SendPhase* phase = request->phase;
+    ip_addr_t destination;
+    IP_ADDR4(&destination, 127, 0, 0, 1);
+
+    for(uint32_t i = 0; i < phase->count; i++) {
+        struct pbuf* p = pbuf_alloc(PBUF_TRANSPORT, phase->size, PBUF_RAM);
+        if( p == NULL ) {
+            printf("failed to allocate pbuf\n");
+            failures++;
+            break;
+        }
+        memset(p->payload, 0, phase->size);
+        uint32_t header[2] = {
+            lwip_htonl(phase->first_sequence + i),
+            lwip_htonl(phase->session),
+        };
+        pbuf_take(p, header, phase->size < sizeof(header) ? phase->size : sizeof(header));
+        err_t err = udp_sendto(sender, p, &destination, TEST_PORT);
+        if( err != ERR_OK ) {
+            printf("udp_sendto failed: %d\n", err);
+            failures++;
+        }
+        pbuf_free(p);
+    }
+    sys_sem_signal(&request->done);
+}
+
+static void send_phase(const SendPhase* phase)
+{
+    SendRequest request = {
+        .phase = phase,
+    };
+    if( sys_sem_new(&request.done, 0) != ERR_OK ) {
+        printf("failed to create semaphore\n");
+        failures++;
+        return;
+    }
+    if( tcpip_callback(send_callback, &request) == ERR_OK ) {
+        sys_sem_wait(&request.done);
+    }
+    else {
+        printf("tcpip_callback failed\n");
+        failures++;
+    }
+    sys_sem_free(&request.done);
+}
+
+static void initialize_callback(void* ctx)
+{
+    struct udp_pcb* receiver = udp_new();
+    udp_bind(receiver, IP_ADDR_ANY, TEST_PORT);
+    udp_recv(receiver, &udp_rx_stats_recv, NULL);
+    sender = udp_new();
+    sys_sem_signal((sys_sem_t*)ctx);
+}
+
+static void check(const char* name, uint64_t actual, uint64_t expected)
+{
+    printf("%-24s %llu (expected %llu)%s\n", name, (unsigned long long)actual, (unsigned long long)expected, actual == expected ? "" : " FAILED");
+    if( actual != expected ) {
+        failures++;
+    }
+}
+
+static void check_le(const char* name, uint64_t actual, uint64_t limit)
+{
+    printf("%-24s %llu (expected <= %llu)%s\n", name, (unsigned long long)actual, (unsigned long long)limit, actual <= limit ? "" : " FAILED");
+    if( actual > limit ) {
+        failures++;
+    }
+}
+
+static uint64_t sum_histogram(const UdpRxStats* stats)
+{
+    uint64_t sum = 0;
+    for(uint32_t i = 0; i < UDP_RX_STATS_HISTOGRAM_BINS; i++) {
+        sum += stats->processing_histogram[i];
+    }
+    return sum;
+}
+
+// Checks the per-second counters. Minimums are 0 if no second has completed in the window.
+static void check_per_second(const UdpRxStats* stats)
+{
+    if( stats->seconds == 0 ) {
+        check("packets_per_sec_min", stats->packets_per_sec_min, 0);
+        check("bytes_per_sec_min", stats->bytes_per_sec_min, 0);
+    }
+    else {
+        check_le("packets_per_sec_min", stats->packets_per_sec_min, stats->packets_per_sec_max);
+        check_le("bytes_per_sec_min", stats->bytes_per_sec_min, stats->bytes_per_sec_max);
+    }
+    check_le("packets_per_sec_max", stats->packets_per_sec_max, stats->packets);
+    check_le("bytes_per_sec_max", stats->bytes_per_sec_max, stats->bytes);
+}
+
+int main(int argc, char* argv[])
+{
+    sys_sem_t initialized;
+    if( sys_sem_new(&initialized, 0) != ERR_OK ) {
+        printf("failed to create semaphore\n");
+        return 1;
+    }
+    tcpip_init(initialize_callback, &initialized);
+    sys_sem_wait(&initialized);
+    sys_sem_free(&initialized);
+
+    if( udp_rx_stats_init() != ERR_OK ) {
+        printf("udp_rx_stats_init failed\n");
+        return 1;
+    }
+    for(size_t i = 0; i < LWIP_ARRAYSIZE(phases); i++) {
+        send_phase(&phases[i]);
+    }
+    // Loopback packets are delivered by netif_poll() queued on the tcpip thread while sending,
+    // so they have all been received when the snapshot request is processed.
+    UdpRxStats stats;
+    if( udp_rx_stats_snapshot(&stats) != ERR_OK ) {
+        printf("udp_rx_stats_snapshot failed\n");
+        return 1;
+    }
+
+    check("packets", stats.packets, 248);
+    check("bytes", stats.bytes, 247*64 + 2);
+    check("lost", stats.lost, 5);
+    check("gaps", stats.gaps, 1);
+    check("out_of_order", stats.out_of_order, 2);
+    check("resyncs", stats.resyncs, 1);
+    check("short_packets", stats.short_packets, 1);
+    check("histogram total", sum_histogram(&stats), stats.packets);
+    check_le("processing_min", stats.processing_min, stats.processing_max);
+    check_per_second(&stats);
+#if LWIP_STATS && IP_STATS
+    check("ip_drop", stats.ip_drop, 0);
+#endif
+#if LWIP_STATS && UDP_STATS
+    check("udp_recv", stats.udp_recv, 248);
+    check("udp_drop", stats.udp_drop, 0);
+#endif
+#if LWIP_STATS && MEMP_STATS
+    // The sender and the receiver.
+    check("memp UDP_PCB used", stats.memp[MEMP_UDP_PCB].used, 2);
+    check("memp UDP_PCB err", stats.memp[MEMP_UDP_PCB].err, 0);
+#endif
+
+    // A window without packets which spans completed seconds.
+    sys_msleep(1500);
+    if( udp_rx_stats_snapshot(&stats) != ERR_OK ) {
+        printf("udp_rx_stats_snapshot failed\n");
+        return 1;
+    }
+    check("idle packets", stats.packets, 0);
+    check("idle seconds", stats.seconds >= 1, 1);
+    check("idle packets_per_sec_min", stats.packets_per_sec_min, 0);
+    check("idle packets_per_sec_max", stats.packets_per_sec_max, 0);
+    check("idle bytes_per_sec_max", stats.bytes_per_sec_max, 0);
+    check("idle processing_min", stats.processing_min, 0);
+    check("idle histogram total", sum_histogram(&stats), 0);
+
+    printf("%s\n", failures == 0 ? "PASSED" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
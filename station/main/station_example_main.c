@@ -24,6 +24,8 @@
 #include "lwip/sys.h"
 #include "lwip/udp.h"
 
+#include "udp_rx_stats.h"
+
 /* The examples use WiFi configuration that you can set via 'make menuconfig'.
 
    If you'd rather not, just change the below entries to strings with
@@ -173,6 +175,10 @@ static void printRuntimeStats()
 #define ENABLE_WIFI
 #endif
 
+#if CONFIG_ENABLE_UDP_RX_STATS
+#define ENABLE_UDP_RX_STATS
+#endif
+
 #if CONFIG_PLACE_CALLBACK_ON_IRAM
 #define PLACE_CALLBACK_ON_IRAM
 #endif
@@ -310,6 +316,9 @@ static IRAM_ATTR void timer_callback(void* arg)
 #endif
 
 static struct udp_pcb* udp_context = NULL;
+#ifdef ENABLE_UDP_RX_STATS
+static bool udp_rx_stats_enabled = false;
+#endif
 static void udp_recv_handler(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port)
 {
     pbuf_free(p);
@@ -318,9 +327,77 @@ static void initialize_udp()
 {
     udp_context = udp_new();
     udp_bind(udp_context, IPADDR_ANY, 10000);
+#ifdef ENABLE_UDP_RX_STATS
+    err_t err = udp_rx_stats_init();
+    if( err == ERR_OK ) {
+        udp_recv(udp_context, &udp_rx_stats_recv, NULL);
+        udp_rx_stats_enabled = true;
+        return;
+    }
+    ESP_LOGE(TAG, "failed to initialize UDP receive statistics: %d", err);
+#endif
     udp_recv(udp_context, &udp_recv_handler, NULL);
 }
 
+#ifdef ENABLE_UDP_RX_STATS
+static void printUdpRxStats()
+{
+    // Nothing has been measured if the statistics failed to initialize.
+    if( !udp_rx_stats_enabled ) {
+        return;
+    }
+    UdpRxStats stats;
+    err_t err = udp_rx_stats_snapshot(&stats);
+    if( err != ERR_OK ) {
+        ESP_LOGW("UDP", "failed to take UDP receive statistics: %d", err);
+        return;
+    }
+
+    float elapsed = stats.elapsed_us/1000000.0f;
+    float packets_per_sec = elapsed > 0 ? stats.packets/elapsed : 0;
+    float bytes_per_sec = elapsed > 0 ? stats.bytes/elapsed : 0;
+    float processing_average = stats.packets > 0 ? (float)stats.processing_sum/stats.packets : 0;
+    ESP_LOGI("UDP", "received: packets = %u, bytes = %llu, elapsed = %f", stats.packets, stats.bytes, elapsed);
+    ESP_LOGI("UDP", "rate:     packets/s = %f (min = %u, max = %u), bytes/s = %f (min = %u, max = %u)", packets_per_sec, stats.packets_per_sec_min, stats.packets_per_sec_max, bytes_per_sec, stats.bytes_per_sec_min, stats.bytes_per_sec_max);
+    ESP_LOGI("UDP", "sequence: lost = %u, gaps = %u, out of order = %u, short = %u, resync = %u", stats.lost, stats.gaps, stats.out_of_order, stats.short_packets, stats.resyncs);
+    ESP_LOGI("UDP", "process:  min = %u, max = %u, average: %f", stats.processing_min, stats.processing_max, processing_average);
+    for(uint32_t i = 0; i < UDP_RX_STATS_HISTOGRAM_BINS; i++) {
+        if( stats.processing_histogram[i] == 0 ) {
+            continue;
+        }
+        if( i < UDP_RX_STATS_HISTOGRAM_BINS - 1 ) {
+            ESP_LOGI("UDP", "process:  < %u[us]\t%u", 1u << i, stats.processing_histogram[i]);
+        }
+        else {
+            ESP_LOGI("UDP", "process: >= %u[us]\t%u", 1u << (i - 1), stats.processing_histogram[i]);
+        }
+    }
+    ESP_LOGI("UDP", "heap:     free = %u, min free = %u, largest free block = %u", stats.heap_free, stats.heap_free_min, stats.heap_largest_free_block);
+#if LWIP_STATS
+#if LINK_STATS
+    ESP_LOGI("UDP", "link:     recv = %u, drop = %u, memerr = %u", stats.link_recv, stats.link_drop, stats.link_memerr);
+#endif
+#if IP_STATS
+    ESP_LOGI("UDP", "ip:       recv = %u, drop = %u, err = %u", stats.ip_recv, stats.ip_drop, stats.ip_err);
+#endif
+#if IPFRAG_STATS
+    ESP_LOGI("UDP", "ip_frag:  recv = %u, drop = %u, err = %u", stats.ipfrag_recv, stats.ipfrag_drop, stats.ipfrag_err);
+#endif
+#if UDP_STATS
+    ESP_LOGI("UDP", "udp:      recv = %u, drop = %u, memerr = %u", stats.udp_recv, stats.udp_drop, stats.udp_memerr);
+#endif
+#if MEM_STATS
+    ESP_LOGI("UDP", "mem:      avail = %u, used = %u, max = %u, err = %u", stats.mem.avail, stats.mem.used, stats.mem.max, stats.mem.err);
+#endif
+#if MEMP_STATS
+    for(uint32_t i = 0; i < MEMP_MAX; i++) {
+        ESP_LOGI("UDP", "memp:     %s\tavail = %u, used = %u, max = %u, err = %u", udp_rx_stats_memp_names[i], stats.memp[i].avail, stats.memp[i].used, stats.memp[i].max, stats.memp[i].err);
+    }
+#endif
+#endif  // LWIP_STATS
+}
+#endif
+
 static void isr_button_pressed(void* arg)
 {
     bool* flag = (bool*)arg;
@@ -418,6 +495,10 @@ void app_main()
         ESP_LOGI("TIMER", "delay:    min = %u, max = %u, average: %f, variance: %f", delay_min, delay_max, delay_average, delay_variance);
         ESP_LOGI("TIMER", "interval: min = %u, max = %u, average: %f, variance: %f", interval_min, interval_max, interval_average, interval_variance);
         printRuntimeStats();
+#ifdef ENABLE_UDP_RX_STATS
+        // This may be delayed while the tcpip mailbox is saturated by incoming packets.
+        printUdpRxStats();
+#endif
 
         if( is_button_pressed ) {
             esp_log_level_set("*", ESP_LOG_NONE);
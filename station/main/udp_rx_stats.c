@@ -0,0 +1,261 @@
+/* UDP receive path statistics
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lwip/def.h"
+#include "lwip/sys.h"
+#include "lwip/stats.h"
+#include "lwip/tcpip.h"
+
+#include "udp_rx_stats.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+static inline int64_t get_time_us(void)
+{
+    return esp_timer_get_time();
+}
+#else
+#include <time.h>
+static inline int64_t get_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec*1000000ll + ts.tv_nsec/1000;
+}
+#endif
+
+#if LWIP_STATS && MEMP_STATS
+const char* const udp_rx_stats_memp_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name,num,size,desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+// All state below is touched only from the tcpip thread.
+static UdpRxStats stats;
+static int64_t window_start = 0;
+static int64_t second_start = 0;
+static uint32_t second_packets = 0;
+static uint32_t second_bytes = 0;
+static bool has_sequence = false;
+static uint32_t next_sequence = 0;
+static uint32_t current_session = 0;
+
+static void reset_window(int64_t now)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.packets_per_sec_min = 0xffffffffu;
+    stats.bytes_per_sec_min = 0xffffffffu;
+    stats.processing_min = 0xffffffffu;
+    window_start = now;
+    second_start = now;
+    second_packets = 0;
+    second_bytes = 0;
+}
+
+// Closes the per-second buckets which have elapsed by now.
+// Seconds without any packet are counted as zero.
+static void update_seconds(int64_t now)
+{
+    while( now - second_start >= 1000000 ) {
+        stats.packets_per_sec_min = second_packets < stats.packets_per_sec_min ? second_packets : stats.packets_per_sec_min;
+        stats.packets_per_sec_max = second_packets > stats.packets_per_sec_max ? second_packets : stats.packets_per_sec_max;
+        stats.bytes_per_sec_min = second_bytes < stats.bytes_per_sec_min ? second_bytes : stats.bytes_per_sec_min;
+        stats.bytes_per_sec_max = second_bytes > stats.bytes_per_sec_max ? second_bytes : stats.bytes_per_sec_max;
+        stats.seconds++;
+        second_packets = 0;
+        second_bytes = 0;
+        second_start += 1000000;
+    }
+}
+
+static void update_sequence(struct pbuf* p)
+{
+    uint32_t header[2];
+    if( pbuf_copy_partial(p, header, UDP_RX_STATS_HEADER_SIZE, 0) != UDP_RX_STATS_HEADER_SIZE ) {
+        stats.short_packets++;
+        return;
+    }
+    uint32_t sequence = lwip_ntohl(header[0]);
+    uint32_t session = lwip_ntohl(header[1]);
+    if( has_sequence && session != current_session ) {
+        stats.resyncs++;
+    }
+    else if( has_sequence ) {
+        // Compare as signed to handle the counter wrapping around.
+        int32_t diff = (int32_t)(sequence - next_sequence);
+        if( diff < 0 ) {
+            stats.out_of_order++;
+            return;
+        }
+        if( diff > 0 ) {
+            stats.lost += (uint32_t)diff;
+            stats.gaps++;
+        }
+    }
+    has_sequence = true;
+    current_session = session;
+    next_sequence = sequence + 1;
+}
+
+static void update_processing_time(uint32_t processing)
+{
+    stats.processing_min = processing < stats.processing_min ? processing : stats.processing_min;
+    stats.processing_max = processing > stats.processing_max ? processing : stats.processing_max;
+    stats.processing_sum += processing;
+
+    uint32_t bin = 0;
+    while( processing > 0 && bin < UDP_RX_STATS_HISTOGRAM_BINS - 1 ) {
+        processing >>= 1;
+        bin++;
+    }
+    stats.processing_histogram[bin]++;
+}
+
+void udp_rx_stats_recv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port)
+{
+    int64_t begin = get_time_us();
+    update_seconds(begin);
+
+    uint16_t length = p->tot_len;
+    stats.packets++;
+    stats.bytes += length;
+    second_packets++;
+    second_bytes += length;
+    update_sequence(p);
+    pbuf_free(p);
+
+    int64_t end = get_time_us();
+    update_processing_time((uint32_t)(end - begin));
+}
+
+#if LWIP_STATS
+static void copy_pool_stats(UdpRxPoolStats* dst, const struct stats_mem* src)
+{
+    dst->avail = src->avail;
+    dst->used = src->used;
+    dst->max = src->max;
+    dst->err = src->err;
+}
+#endif
+
+static void take_snapshot(UdpRxStats* snapshot)
+{
+    int64_t now = get_time_us();
+    update_seconds(now);
+    stats.elapsed_us = now - window_start;
+    if( stats.seconds == 0 ) {
+        stats.packets_per_sec_min = 0;
+        stats.bytes_per_sec_min = 0;
+    }
+    if( stats.packets == 0 ) {
+        stats.processing_min = 0;
+    }
+
+#ifdef ESP_PLATFORM
+    stats.heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    stats.heap_free_min = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    stats.heap_largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+
+#if LWIP_STATS
+#if MEMP_STATS
+    for(uint32_t i = 0; i < MEMP_MAX; i++) {
+        copy_pool_stats(&stats.memp[i], lwip_stats.memp[i]);
+    }
+#endif
+#if MEM_STATS
+    copy_pool_stats(&stats.mem, &lwip_stats.mem);
+#endif
+#if LINK_STATS
+    stats.link_recv = lwip_stats.link.recv;
+    stats.link_drop = lwip_stats.link.drop;
+    stats.link_memerr = lwip_stats.link.memerr;
+#endif
+#if IP_STATS
+    stats.ip_recv = lwip_stats.ip.recv;
+    stats.ip_drop = lwip_stats.ip.drop;
+    stats.ip_err = lwip_stats.ip.err;
+#endif
+#if IPFRAG_STATS
+    stats.ipfrag_recv = lwip_stats.ip_frag.recv;
+    stats.ipfrag_drop = lwip_stats.ip_frag.drop;
+    stats.ipfrag_err = lwip_stats.ip_frag.err;
+#endif
+#if UDP_STATS
+    stats.udp_recv = lwip_stats.udp.recv;
+    stats.udp_drop = lwip_stats.udp.drop;
+    stats.udp_memerr = lwip_stats.udp.memerr;
+#endif
+#endif  // LWIP_STATS
+
+    memcpy(snapshot, &stats, sizeof(stats));
+    reset_window(now);
+}
+
+typedef struct {
+    UdpRxStats* stats;
+    sys_sem_t done;
+} SnapshotRequest;
+
+static void snapshot_callback(void* ctx)
+{
+    SnapshotRequest* request = (SnapshotRequest*)ctx;
+    take_snapshot(request->stats);
+    sys_sem_signal(&request->done);
+}
+
+static void init_callback(void* ctx)
+{
+    sys_sem_t* done = (sys_sem_t*)ctx;
+    reset_window(get_time_us());
+    has_sequence = false;
+    sys_sem_signal(done);
+}
+
+// Runs callback on the tcpip thread and waits for it to signal the semaphore passed in ctx.
+static err_t run_on_tcpip_thread(tcpip_callback_fn callback, void* ctx, sys_sem_t* done)
+{
+    err_t err = sys_sem_new(done, 0);
+    if( err != ERR_OK ) {
+        return err;
+    }
+    // tcpip_callback() blocks while the tcpip mailbox is full and fails only when the message cannot be allocated
+    // from MEMP_TCPIP_MSG_API. Waiting for the semaphore in that case would block forever.
+    err = tcpip_callback(callback, ctx);
+    if( err == ERR_OK ) {
+        sys_sem_wait(done);
+    }
+    sys_sem_free(done);
+    return err;
+}
+
+err_t udp_rx_stats_init(void)
+{
+    sys_sem_t done;
+    return run_on_tcpip_thread(init_callback, &done, &done);
+}
+
+err_t udp_rx_stats_snapshot(UdpRxStats* snapshot)
+{
+    // The receive callback runs on the tcpip thread, so the snapshot is taken there to get consistent counters without locking.
+    SnapshotRequest request = {
+        .stats = snapshot,
+    };
+    err_t err = run_on_tcpip_thread(snapshot_callback, &request, &request.done);
+    if( err != ERR_OK ) {
+        // The current window continues and will be reported by the next successful snapshot.
+        memset(snapshot, 0, sizeof(*snapshot));
+    }
+    return err;
+}
@@ -0,0 +1,127 @@
+/* UDP receive path statistics
+
+   Counts packets received on the measurement UDP port, measures the time
+   spent in the receive callback and detects sequence gaps against the
+   header the host sender puts at the head of each datagram: a 32-bit
+   big-endian sequence counter followed by a 32-bit session ID chosen when
+   the sender starts. Only lwIP APIs are used, so this also builds against
+   the lwIP unix port for testing with loopback traffic on Linux.
+*/
+#ifndef UDP_RX_STATS_H__
+#define UDP_RX_STATS_H__
+
+#include <stdint.h>
+
+#include "lwip/opt.h"
+#include "lwip/err.h"
+#include "lwip/ip_addr.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/memp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Processing time histogram.
+// Bin 0 holds [0, 1) [us], bin n holds [2^(n-1), 2^n) [us] and the last bin holds everything above.
+#define UDP_RX_STATS_HISTOGRAM_BINS 16
+
+// Size of the header embedded by the sender.
+#define UDP_RX_STATS_HEADER_SIZE 8
+
+typedef struct {
+    uint32_t avail;
+    uint32_t used;
+    uint32_t max;
+    uint32_t err;
+} UdpRxPoolStats;
+
+typedef struct {
+    int64_t  elapsed_us;            // Length of the measurement window.
+    uint32_t packets;
+    uint64_t bytes;
+
+    // Per-second counters. Only completed seconds are taken into account.
+    uint32_t seconds;
+    uint32_t packets_per_sec_min;
+    uint32_t packets_per_sec_max;
+    uint32_t bytes_per_sec_min;
+    uint32_t bytes_per_sec_max;
+
+    // Sequence counter embedded by the sender.
+    uint32_t lost;                  // Number of sequence numbers skipped.
+    uint32_t gaps;                  // Number of times a skip was detected.
+    uint32_t out_of_order;          // Duplicated or reordered packets.
+    uint32_t short_packets;         // Packets too short to hold the header.
+    uint32_t resyncs;               // Sender restarts detected by a session ID change.
+
+    // Time spent in the receive callback, including pbuf_free().
+    uint32_t processing_min;
+    uint32_t processing_max;
+    uint64_t processing_sum;
+    uint32_t processing_histogram[UDP_RX_STATS_HISTOGRAM_BINS];
+
+#ifdef ESP_PLATFORM
+    // ESP-IDF builds lwIP with MEM_LIBC_MALLOC and MEMP_MEM_MALLOC, so pbufs come from the heap and
+    // lwIP has no pool statistics. The 8-bit capable heap is reported instead, at the end of the window.
+    uint32_t heap_free;
+    uint32_t heap_free_min;         // Lowest free size since boot.
+    uint32_t heap_largest_free_block;
+#endif
+
+    // Snapshot of the lwIP statistics at the end of the window. These counters are cumulative.
+    // The memory pool statistics are available only if lwIP uses its own pools, e.g. with the unix port.
+#if LWIP_STATS
+#if MEMP_STATS
+    UdpRxPoolStats memp[MEMP_MAX];
+#endif
+#if MEM_STATS
+    UdpRxPoolStats mem;
+#endif
+#if LINK_STATS
+    uint32_t link_recv;
+    uint32_t link_drop;
+    uint32_t link_memerr;
+#endif
+#if IP_STATS
+    uint32_t ip_recv;
+    uint32_t ip_drop;
+    uint32_t ip_err;
+#endif
+#if IPFRAG_STATS
+    uint32_t ipfrag_recv;
+    uint32_t ipfrag_drop;
+    uint32_t ipfrag_err;
+#endif
+#if UDP_STATS
+    uint32_t udp_recv;
+    uint32_t udp_drop;
+    uint32_t udp_memerr;
+#endif
+#endif  // LWIP_STATS
+} UdpRxStats;
+
+#if LWIP_STATS && MEMP_STATS
+// Names of the lwIP memory pools, indexed in the same order as UdpRxStats::memp.
+extern const char* const udp_rx_stats_memp_names[MEMP_MAX];
+#endif
+
+// Resets all counters and starts a new measurement window.
+// Returns an error if the request could not be posted to the tcpip thread.
+err_t udp_rx_stats_init(void);
+
+// Receive callback to be registered by udp_recv(). It frees the pbuf.
+void udp_rx_stats_recv(void* arg, struct udp_pcb* pcb, struct pbuf* p, const ip_addr_t* addr, uint16_t port);
+
+// Copies the statistics of the current window to stats and starts a new window.
+// This must not be called from the tcpip thread since it waits for the tcpip thread to take the snapshot.
+// The caller is blocked while the tcpip mailbox is full, e.g. under a UDP flood, until the request can be posted.
+// On error stats is zeroed and the current window is kept.
+err_t udp_rx_stats_snapshot(UdpRxStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // UDP_RX_STATS_H__